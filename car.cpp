@@ -1,28 +1,23 @@
+// Containers come from catalog.h; the Car classes this file uses
+// (Sedan/SUV/Truck with displayDetails) are not part of the tree.
+#include "catalog.h"
 
 int main() {
      // Create containers
      LinkedList<Car*> carCatalog;
      BinarySearchTree<Car*> priceSortedCars;
+     SearchIndex<Car*> carSearch;
      
      bool running = true;
      int choice;
      
-     // Add some sample cars to the catalog
+     // Add some sample cars to the catalog in one batch
      try {
-         // Add a Sedan
-         Sedan* sedan1 = new Sedan("Toyota", "Camry", 2022, 25000);
-         carCatalog.addByCategory(sedan1);
-         priceSortedCars.insert(sedan1);
-         
-         // Add an SUV
-         SUV* suv1 = new SUV("Honda", "CR-V", 2023, 32000);
-         carCatalog.addByCategory(suv1);
-         priceSortedCars.insert(suv1);
-         
-         // Add a Truck
-         Truck* truck1 = new Truck("Ford", "F-150", 2021, 40000);
-         carCatalog.addByCategory(truck1);
-         priceSortedCars.insert(truck1);
+         vector<Car*> samples;
+         samples.push_back(new Sedan("Toyota", "Camry", 2022, 25000));
+         samples.push_back(new SUV("Honda", "CR-V", 2023, 32000));
+         samples.push_back(new Truck("Ford", "F-150", 2021, 40000));
+         upsertBatch(carCatalog, priceSortedCars, samples, &carSearch);
      } catch (const exception& e) {
          cout << "Error adding sample cars: " << e.what() << endl;
      }
@@ -191,6 +186,7 @@ int main() {
                      if (newCar != nullptr) {
                          carCatalog.addByCategory(newCar);
                          priceSortedCars.insert(newCar);
+                         carSearch.add(newCar);
                          cout << "\nCar added successfully!" << endl;
                      }
                      
@@ -199,7 +195,7 @@ int main() {
                  case 2: {
                      // Display all cars
                      cout << "\n===== All Cars in Catalog =====" << endl;
-                     carCatalog.displayAll();
+                     carCatalog.displayAll(displayCar);
                      break;
                  }
                  case 3: {
@@ -231,7 +227,7 @@ int main() {
                      }
                      
                      cout << "\n===== " << category << "s in Catalog =====" << endl;
-                     carCatalog.displayByCategory(category);
+                     carCatalog.displayByCategory(category, displayCar);
                      break;
                  }
                  case 4: {
@@ -254,11 +250,18 @@ int main() {
                      cout << "Enter model: ";
                      getline(cin, model);
                      
-                     Car* foundCar = carCatalog.find(make, model);
+                     // Case-insensitive prefix match first, then allow for typos
+                     string query = make.empty() ? model : (model.empty() ? make : make + " " + model);
+                     vector<Car*> matches = carSearch.prefixSearch(query);
+                     if (matches.empty()) {
+                         matches = carSearch.fuzzySearch(query);
+                     }
                      
-                     if (foundCar != nullptr) {
-                         cout << "\n===== Car Found =====" << endl;
-                         foundCar->displayDetails();
+                     if (!matches.empty()) {
+                         cout << "\n===== Cars Found =====" << endl;
+                         for (Car* match : matches) {
+                             match->displayDetails();
+                         }
                      } else {
                          cout << "\nCar not found." << endl;
                      }
@@ -278,37 +281,10 @@ int main() {
                      Car* foundCar = carCatalog.find(make, model);
                      
                      if (foundCar != nullptr) {
-                         // Need to rebuild BST after removal
-                         // First, get all cars from linked list except the one to remove
-                         LinkedList<Car*> tempList;
-                         Node<Car*>* current = carCatalog.head;
-                         
-                         while (current != nullptr) {
-                             if (current->data != foundCar) {
-                                 tempList.addToEnd(current->data);
-                             }
-                             current = current->next;
-                         }
-                         
-                         // Remove from linked list
-                         bool removed = carCatalog.remove(foundCar);
-                         
-                         if (removed) {
-                             // Rebuild BST
-                             BinarySearchTree<Car*> newBST;
-                             current = tempList.head;
-                             
-                             while (current != nullptr) {
-                                 newBST.insert(current->data);
-                                 current = current->next;
-                             }
-                             
-                             // Replace old BST with new one
-                             priceSortedCars = newBST;
-                             
-                             // Delete the car object
-                             delete foundCar;
-                             
+                         // Unlink from the list, then let the BST retire the car.
+                         // It is deleted once no snapshot of the BST can reach it.
+                         carSearch.remove(foundCar);
+                         if (carCatalog.remove(foundCar) && priceSortedCars.remove(foundCar)) {
                              cout << "\nCar removed successfully!" << endl;
                          } else {
                              cout << "\nFailed to remove car." << endl;
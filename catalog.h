@@ -0,0 +1,1086 @@
+// Car Catalog Project
+// Header-only containers used by final.cpp. car.cpp is written against the
+// same API but is an incomplete fragment: its Car classes are not in the tree.
+
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Key extractors. Each one pulls the sort key out of a car pointer so the
+// containers compare keys directly instead of going through the Car class.
+struct ByCategory {
+    template <typename P>
+    std::string operator()(const P& item) const { return item->getType(); }
+};
+
+struct ByCost {
+    template <typename P>
+    double operator()(const P& item) const { return item->getCost(); }
+};
+
+struct ByYear {
+    template <typename P>
+    int operator()(const P& item) const { return item->getModelYear(); }
+};
+
+// Identity of a listing for deduplication: make, model, year and type.
+// Two cars with the same identity are the same listing sent twice.
+struct ByListing {
+    template <typename P>
+    std::string operator()(const P& item) const {
+        return item->getMake() + '\n' + item->getModel() + '\n' +
+               std::to_string(item->getModelYear()) + '\n' + item->getType();
+    }
+};
+
+// Ownership policies: what a container does with an item it lets go of
+// for good. A catalog's list and tree share the same items and the same
+// policy, and split the job: the tree releases items that leave the
+// catalog (removed or replaced), since only it knows when no snapshot can
+// reach them, and the list releases the items still listed when it is
+// cleared. KeepItem is for containers that never own their items, such as
+// a secondary index over cars some other catalog holds.
+struct DeleteItem {
+    template <typename P>
+    void operator()(P item) const { delete item; }
+};
+
+struct KeepItem {
+    template <typename P>
+    void operator()(const P&) const {}
+};
+
+// Containers of raw pointers own them by default; anything else is kept
+template <typename T>
+using DefaultRelease = typename std::conditional<std::is_pointer<T>::value, DeleteItem, KeepItem>::type;
+
+// Node class for the linked list
+template <typename T>
+class Node {
+public:
+    T data;
+    Node* next;
+
+    Node(T data) {
+        this->data = data;
+        next = nullptr;
+    }
+};
+
+// Linked list kept grouped by KeyOf (the car's category by default).
+// Release is applied to every item left in the list when it is cleared.
+template <typename T, typename KeyOf = ByCategory, typename Compare = std::less<>,
+          typename Release = DefaultRelease<T>>
+class LinkedList {
+private:
+    Node<T>* head;
+
+    static bool before(const T& a, const T& b) {
+        return Compare()(KeyOf()(a), KeyOf()(b));
+    }
+
+public:
+    LinkedList() {
+        head = nullptr;
+    }
+
+    LinkedList(const LinkedList&) = delete;
+    LinkedList& operator=(const LinkedList&) = delete;
+
+    // Destructor to free memory
+    ~LinkedList() {
+        clear();
+    }
+
+    bool isEmpty() const {
+        return head == nullptr;
+    }
+
+    // Add an item after every item with a key not greater than its own
+    void addByCategory(T item) {
+        Node<T>* newNode = new Node<T>(item);
+
+        // If list is empty or the new item should be at the beginning
+        if (head == nullptr || before(item, head->data)) {
+            newNode->next = head;
+            head = newNode;
+            return;
+        }
+
+        // Find the right position to insert
+        Node<T>* current = head;
+        while (current->next != nullptr && !before(item, current->next->data)) {
+            current = current->next;
+        }
+
+        newNode->next = current->next;
+        current->next = newNode;
+    }
+
+    // Add an item at the end regardless of its key
+    void addToEnd(T item) {
+        Node<T>* newNode = new Node<T>(item);
+
+        if (head == nullptr) {
+            head = newNode;
+            return;
+        }
+
+        Node<T>* current = head;
+        while (current->next != nullptr) {
+            current = current->next;
+        }
+        current->next = newNode;
+    }
+
+    // First item with the given make and model, or an empty T
+    T find(const std::string& make, const std::string& model) const {
+        for (Node<T>* current = head; current != nullptr; current = current->next) {
+            if (current->data->getMake() == make && current->data->getModel() == model) {
+                return current->data;
+            }
+        }
+        return T();
+    }
+
+    // Unlink an item without deleting it (the cost tree deletes removed cars)
+    bool remove(T item) {
+        Node<T>** link = &head;
+        while (*link != nullptr && (*link)->data != item) {
+            link = &(*link)->next;
+        }
+
+        if (*link == nullptr) {
+            return false;
+        }
+
+        Node<T>* found = *link;
+        *link = found->next;
+        delete found;
+        return true;
+    }
+
+    // Add a batch of items and unlink every existing item matching replaces,
+    // in one pass over the list. Each new item lands where addByCategory
+    // would have put it. Returns the unlinked items, undeleted.
+    template <typename Pred>
+    std::vector<T> mergeBatch(std::vector<T> items, Pred replaces) {
+        std::stable_sort(items.begin(), items.end(), before);
+
+        std::vector<T> removed;
+        std::size_t next = 0;
+        Node<T>** link = &head;
+        while (*link != nullptr) {
+            Node<T>* existing = *link;
+            if (replaces(existing->data)) {
+                *link = existing->next;
+                removed.push_back(existing->data);
+                delete existing;
+                continue;
+            }
+
+            while (next < items.size() && before(items[next], existing->data)) {
+                Node<T>* newNode = new Node<T>(items[next++]);
+                newNode->next = existing;
+                *link = newNode;
+                link = &newNode->next;
+            }
+            link = &existing->next;
+        }
+
+        for (; next < items.size(); next++) {
+            *link = new Node<T>(items[next]);
+            link = &(*link)->next;
+        }
+        return removed;
+    }
+
+    // Delete every node and release the item it holds
+    void clear() {
+        Node<T>* current = head;
+        while (current != nullptr) {
+            Node<T>* next = current->next;
+            Release()(current->data);
+            delete current;
+            current = next;
+        }
+        head = nullptr;
+    }
+
+    // Pass every item to display in list order; returns how many there were
+    template <typename Display>
+    int displayAll(Display display) const {
+        int count = 0;
+        for (Node<T>* current = head; current != nullptr; current = current->next) {
+            display(current->data);
+            count++;
+        }
+        return count;
+    }
+
+    // Pass every item whose key matches to display; returns how many there were
+    template <typename Key, typename Display>
+    int displayByCategory(const Key& key, Display display) const {
+        Compare compare;
+        int count = 0;
+        for (Node<T>* current = head; current != nullptr; current = current->next) {
+            auto itemKey = KeyOf()(current->data);
+            if (!compare(itemKey, key) && !compare(key, itemKey)) {
+                display(current->data);
+                count++;
+            }
+        }
+        return count;
+    }
+};
+
+// Node class for Binary Search Tree
+// Nodes never change once built, so every version of the tree shares them.
+// An add or remove only copies the nodes on the path it walks, and the tree
+// is kept AVL-balanced so that path is O(log n) long.
+template <typename T>
+class TreeNode {
+public:
+    const T data;
+    const std::shared_ptr<const TreeNode> left;
+    const std::shared_ptr<const TreeNode> right;
+    const int height;
+
+    TreeNode(T data, std::shared_ptr<const TreeNode> left, std::shared_ptr<const TreeNode> right)
+        : data(data), left(left), right(right),
+          height(1 + std::max(left ? left->height : 0, right ? right->height : 0)) {}
+};
+
+// One published version of the tree
+template <typename T, typename Release>
+class TreeVersion {
+public:
+    const std::shared_ptr<const TreeNode<T>> root;
+
+    // The version after this one. Holding an old version keeps every newer
+    // one alive too, so items retired later can't be deleted under a reader.
+    // The writer sets it while readers may be dropping this version, so it
+    // is only read and written through std::atomic_load/store/exchange.
+    std::shared_ptr<TreeVersion> next;
+
+    // Items removed when the next version was published. Readers of this
+    // version can still reach them, so they are released along with it.
+    std::vector<T> retired;
+
+    TreeVersion(std::shared_ptr<const TreeNode<T>> root) : root(root) {}
+
+    ~TreeVersion() {
+        for (T item : retired) {
+            Release()(item);
+        }
+
+        // Free the newer versions one at a time rather than by nested
+        // destructors, which could overflow the stack after a long read.
+        // Detaching next before each release keeps every step shallow.
+        // use_count() only decides whether to detach; the atomic exchange is
+        // what orders this read of next after the writer's store.
+        std::shared_ptr<TreeVersion> successor = std::atomic_exchange(&next, std::shared_ptr<TreeVersion>());
+        while (successor != nullptr && successor.use_count() == 1) {
+            std::shared_ptr<TreeVersion> after = std::atomic_exchange(&successor->next, std::shared_ptr<TreeVersion>());
+            successor = std::move(after);
+        }
+    }
+};
+
+// Binary search tree ordered by KeyOf (the car's cost by default)
+// Readers take a snapshot and see the same items for as long as they hold
+// it, while inserts and removes publish new versions alongside it.
+// Release is applied to removed items once no snapshot can reach them.
+template <typename T, typename KeyOf = ByCost, typename Compare = std::less<>,
+          typename Release = DefaultRelease<T>>
+class BinarySearchTree {
+public:
+    // A pinned, read-only view of the tree
+    typedef std::shared_ptr<const TreeVersion<T, Release>> Snapshot;
+
+private:
+    typedef std::shared_ptr<const TreeNode<T>> NodePtr;
+
+    std::shared_ptr<TreeVersion<T, Release>> current;
+    std::mutex writeLock;
+
+    // Items in the current version; only touched under writeLock
+    std::size_t itemCount;
+
+    static bool before(const T& a, const T& b) {
+        return Compare()(KeyOf()(a), KeyOf()(b));
+    }
+
+    static int heightOf(const NodePtr& node) {
+        return node ? node->height : 0;
+    }
+
+    static NodePtr makeNode(T data, NodePtr left, NodePtr right) {
+        return std::make_shared<const TreeNode<T>>(data, left, right);
+    }
+
+    // New node over left and right, rotated if their heights differ by two.
+    // Rotations build new nodes too, so old versions are never touched.
+    static NodePtr balance(T data, NodePtr left, NodePtr right) {
+        if (heightOf(left) > heightOf(right) + 1) {
+            if (heightOf(left->left) >= heightOf(left->right)) {
+                return makeNode(left->data, left->left, makeNode(data, left->right, right));
+            }
+            const TreeNode<T>* pivot = left->right.get();
+            return makeNode(pivot->data, makeNode(left->data, left->left, pivot->left),
+                            makeNode(data, pivot->right, right));
+        }
+
+        if (heightOf(right) > heightOf(left) + 1) {
+            if (heightOf(right->right) >= heightOf(right->left)) {
+                return makeNode(right->data, makeNode(data, left, right->left), right->right);
+            }
+            const TreeNode<T>* pivot = right->left.get();
+            return makeNode(pivot->data, makeNode(data, left, pivot->left),
+                            makeNode(right->data, pivot->right, right->right));
+        }
+
+        return makeNode(data, left, right);
+    }
+
+    static NodePtr insertAt(const NodePtr& node, T item) {
+        if (node == nullptr) {
+            return makeNode(item, nullptr, nullptr);
+        }
+
+        if (before(item, node->data)) {
+            return balance(node->data, insertAt(node->left, item), node->right);
+        }
+        return balance(node->data, node->left, insertAt(node->right, item));
+    }
+
+    // Subtree without its leftmost node
+    static NodePtr removeSmallest(const NodePtr& node) {
+        if (node->left == nullptr) {
+            return node->right;
+        }
+        return balance(node->data, removeSmallest(node->left), node->right);
+    }
+
+    // Returns node unchanged if item isn't in its subtree
+    static NodePtr removeAt(const NodePtr& node, T item) {
+        if (node == nullptr) {
+            return nullptr;
+        }
+
+        if (node->data == item) {
+            if (node->left == nullptr) {
+                return node->right;
+            }
+            if (node->right == nullptr) {
+                return node->left;
+            }
+
+            // Two children: take the smallest item from the right side
+            const TreeNode<T>* successor = node->right.get();
+            while (successor->left != nullptr) {
+                successor = successor->left.get();
+            }
+            return balance(successor->data, node->left, removeSmallest(node->right));
+        }
+
+        // Items with equal keys may sit on either side
+        NodePtr left = node->left;
+        NodePtr right = node->right;
+        if (!before(node->data, item)) {
+            left = removeAt(node->left, item);
+        }
+        if (left == node->left && !before(item, node->data)) {
+            right = removeAt(node->right, item);
+        }
+
+        if (left == node->left && right == node->right) {
+            return node;
+        }
+        return balance(node->data, left, right);
+    }
+
+    // Make newRoot the current version. Caller must hold writeLock.
+    void publish(NodePtr newRoot) {
+        std::shared_ptr<TreeVersion<T, Release>> newVersion = std::make_shared<TreeVersion<T, Release>>(newRoot);
+        std::atomic_store(&current->next, newVersion);
+        std::atomic_store(&current, newVersion);
+    }
+
+    // low to high Traversal
+    template <typename Display>
+    static void inOrderTraversal(const TreeNode<T>* node, Display& display) {
+        if (node != nullptr) {
+            inOrderTraversal(node->left.get(), display);
+            display(node->data);
+            inOrderTraversal(node->right.get(), display);
+        }
+    }
+
+    // high to low Traversal
+    template <typename Display>
+    static void reverseInOrderTraversal(const TreeNode<T>* node, Display& display) {
+        if (node != nullptr) {
+            reverseInOrderTraversal(node->right.get(), display);
+            display(node->data);
+            reverseInOrderTraversal(node->left.get(), display);
+        }
+    }
+
+    // mergeBatch rebuilds the whole tree only when the batch changes at
+    // least one item in this many
+    static const std::size_t rebuildFraction = 4;
+
+    // Below this many items a bulk build step runs on the calling thread
+    static const std::size_t serialCutoff = 1 << 14;
+
+    // Levels of two-way splitting that keep the work on at most threads
+    // threads: 2^depth pieces, with depth rounded down
+    static int parallelDepth(unsigned int threads = std::thread::hardware_concurrency()) {
+        unsigned int cores = std::max(1u, threads);
+        int depth = 0;
+        while ((2u << depth) <= cores) {
+            depth++;
+        }
+        return depth;
+    }
+
+    // Merge sort items[begin, end), sorting the halves on separate threads
+    static void parallelSort(std::vector<T>& items, std::size_t begin, std::size_t end, int depth) {
+        if (depth == 0 || end - begin < serialCutoff) {
+            std::stable_sort(items.begin() + begin, items.begin() + end, before);
+            return;
+        }
+
+        std::size_t mid = begin + (end - begin) / 2;
+        std::future<void> left = std::async(std::launch::async, parallelSort,
+                                            std::ref(items), begin, mid, depth - 1);
+        parallelSort(items, mid, end, depth - 1);
+        left.get();
+        std::inplace_merge(items.begin() + begin, items.begin() + mid, items.begin() + end, before);
+    }
+
+    // Build a balanced subtree from sorted[begin, end), building the left
+    // side on another thread while this one builds the right
+    static NodePtr buildBalanced(const std::vector<T>& sorted, std::size_t begin, std::size_t end, int depth) {
+        if (begin == end) {
+            return nullptr;
+        }
+
+        std::size_t mid = begin + (end - begin) / 2;
+        if (depth == 0 || end - begin < serialCutoff) {
+            return std::make_shared<const TreeNode<T>>(sorted[mid], buildBalanced(sorted, begin, mid, 0),
+                                                       buildBalanced(sorted, mid + 1, end, 0));
+        }
+
+        std::future<NodePtr> left = std::async(std::launch::async, buildBalanced,
+                                               std::cref(sorted), begin, mid, depth - 1);
+        NodePtr right = buildBalanced(sorted, mid + 1, end, depth - 1);
+        return std::make_shared<const TreeNode<T>>(sorted[mid], left.get(), right);
+    }
+
+    // Cut the top of the tree into in-order pieces: whole subtrees to walk
+    // (second == true) and the single nodes between them (second == false)
+    static void splitPieces(const TreeNode<T>* node, int depth,
+                            std::vector<std::pair<const TreeNode<T>*, bool>>& pieces) {
+        if (node == nullptr) {
+            return;
+        }
+        if (depth == 0) {
+            pieces.push_back(std::make_pair(node, true));
+            return;
+        }
+
+        splitPieces(node->left.get(), depth - 1, pieces);
+        pieces.push_back(std::make_pair(node, false));
+        splitPieces(node->right.get(), depth - 1, pieces);
+    }
+
+public:
+    BinarySearchTree() {
+        current = std::make_shared<TreeVersion<T, Release>>(nullptr);
+        itemCount = 0;
+    }
+
+    BinarySearchTree(const BinarySearchTree&) = delete;
+    BinarySearchTree& operator=(const BinarySearchTree&) = delete;
+
+    void insert(T item) {
+        std::lock_guard<std::mutex> guard(writeLock);
+        publish(insertAt(current->root, item));
+        itemCount++;
+    }
+
+    // Take item out of the tree. It is released once no snapshot can see
+    // it, so the caller must not delete it (unlink it from the list first).
+    bool remove(T item) {
+        std::lock_guard<std::mutex> guard(writeLock);
+        NodePtr newRoot = removeAt(current->root, item);
+        if (newRoot == current->root) {
+            return false;
+        }
+        current->retired.push_back(item);
+        publish(newRoot);
+        itemCount--;
+        return true;
+    }
+
+    // Replace the tree with a balanced one built from items, sorting and
+    // building on up to threads threads. Items already in the tree are
+    // dropped from it but not deleted; the list still owns them.
+    void bulkBuild(std::vector<T> items, unsigned int threads = std::thread::hardware_concurrency()) {
+        int depth = parallelDepth(threads);
+        parallelSort(items, 0, items.size(), depth);
+        NodePtr newRoot = buildBalanced(items, 0, items.size(), depth);
+
+        std::lock_guard<std::mutex> guard(writeLock);
+        publish(newRoot);
+        itemCount = items.size();
+    }
+
+    // Add batch and take out replaced, publishing one new version. Replaced
+    // items are retired like remove() retires them. Resent items are already
+    // in the tree and also in batch: they move to their current key and are
+    // not retired.
+    // A small batch is applied with path-copying inserts and removes, so an
+    // old snapshot pins only the copied paths. A batch that changes a large
+    // share of the tree (see rebuildFraction) instead merges the current
+    // items with the sorted batch and rebuilds it balanced. That is cheaper
+    // than that many single updates, but a snapshot held across it pins a
+    // second full copy of the tree. The rebuild is also the fallback when a
+    // path-copying remove misses because an item's key changed in place.
+    void mergeBatch(std::vector<T> batch, const std::vector<T>& replaced,
+                    const std::vector<T>& resent = std::vector<T>()) {
+        std::lock_guard<std::mutex> guard(writeLock);
+
+        if ((batch.size() + replaced.size()) * rebuildFraction < itemCount) {
+            NodePtr newRoot = current->root;
+            bool missed = false;
+            for (const std::vector<T>* leaving : {&replaced, &resent}) {
+                for (std::size_t i = 0; i < leaving->size() && !missed; i++) {
+                    NodePtr without = removeAt(newRoot, (*leaving)[i]);
+                    missed = without == newRoot;
+                    newRoot = without;
+                }
+            }
+
+            if (!missed) {
+                for (T item : batch) {
+                    newRoot = insertAt(newRoot, item);
+                }
+                itemCount += batch.size() - replaced.size() - resent.size();
+
+                current->retired.insert(current->retired.end(), replaced.begin(), replaced.end());
+                publish(newRoot);
+                return;
+            }
+        }
+
+        int depth = parallelDepth();
+        parallelSort(batch, 0, batch.size(), depth);
+
+        std::unordered_set<T> gone(replaced.begin(), replaced.end());
+        gone.insert(resent.begin(), resent.end());
+        std::vector<T> kept;
+        auto keep = [&kept, &gone](const T& item) {
+            if (gone.count(item) == 0) {
+                kept.push_back(item);
+            }
+        };
+        inOrderTraversal(current->root.get(), keep);
+
+        std::vector<T> merged;
+        merged.reserve(kept.size() + batch.size());
+        std::merge(kept.begin(), kept.end(), batch.begin(), batch.end(), std::back_inserter(merged), before);
+        NodePtr newRoot = buildBalanced(merged, 0, merged.size(), depth);
+
+        current->retired.insert(current->retired.end(), replaced.begin(), replaced.end());
+        publish(newRoot);
+        itemCount = merged.size();
+    }
+
+    // Every item in view, low to high. The tree is cut parallelDepth(threads)
+    // levels down, each subtree below the cut is walked on its own thread
+    // (at most threads of them) and the results are joined in order.
+    std::vector<T> exportLowToHigh(const Snapshot& view,
+                                   unsigned int threads = std::thread::hardware_concurrency()) const {
+        std::vector<std::pair<const TreeNode<T>*, bool>> pieces;
+        splitPieces(view->root.get(), parallelDepth(threads), pieces);
+
+        std::vector<std::future<std::vector<T>>> parts;
+        for (const std::pair<const TreeNode<T>*, bool>& piece : pieces) {
+            if (piece.second) {
+                parts.push_back(std::async(std::launch::async, [piece]() {
+                    std::vector<T> part;
+                    auto collect = [&part](const T& item) { part.push_back(item); };
+                    inOrderTraversal(piece.first, collect);
+                    return part;
+                }));
+            }
+        }
+
+        std::vector<T> sorted;
+        std::size_t next = 0;
+        for (const std::pair<const TreeNode<T>*, bool>& piece : pieces) {
+            if (piece.second) {
+                std::vector<T> part = parts[next++].get();
+                sorted.insert(sorted.end(), part.begin(), part.end());
+            } else {
+                sorted.push_back(piece.first->data);
+            }
+        }
+        return sorted;
+    }
+
+    // Pin the current version for reading
+    Snapshot snapshot() const {
+        return std::atomic_load(&current);
+    }
+
+    template <typename Display>
+    void displayLowToHigh(Display display) const {
+        displayLowToHigh(snapshot(), display);
+    }
+
+    template <typename Display>
+    void displayLowToHigh(const Snapshot& view, Display display) const {
+        inOrderTraversal(view->root.get(), display);
+    }
+
+    template <typename Display>
+    void displayHighToLow(Display display) const {
+        displayHighToLow(snapshot(), display);
+    }
+
+    template <typename Display>
+    void displayHighToLow(const Snapshot& view, Display display) const {
+        reverseInOrderTraversal(view->root.get(), display);
+    }
+};
+
+// Bounded edit distance between a and b, or limit + 1 if it is over limit.
+// Uses Myers' bit-vector method, which updates a whole column of the
+// distance table per character with a few word-wide operations.
+inline int boundedEditDistance(const std::string& a, const std::string& b, int limit) {
+    int lengthGap = (int)a.size() - (int)b.size();
+    if (lengthGap > limit || -lengthGap > limit) {
+        return limit + 1;
+    }
+    if (a.empty() || b.empty()) {
+        return (int)std::max(a.size(), b.size());
+    }
+
+    // Longer than one word: plain row-by-row table
+    if (a.size() > 64) {
+        std::vector<int> row(b.size() + 1);
+        for (std::size_t j = 0; j <= b.size(); j++) {
+            row[j] = (int)j;
+        }
+        for (std::size_t i = 1; i <= a.size(); i++) {
+            int diagonal = row[0];
+            row[0] = (int)i;
+            int best = row[0];
+            for (std::size_t j = 1; j <= b.size(); j++) {
+                int above = row[j];
+                row[j] = std::min({above + 1, row[j - 1] + 1, diagonal + (a[i - 1] != b[j - 1])});
+                diagonal = above;
+                best = std::min(best, row[j]);
+            }
+            if (best > limit) {
+                return limit + 1;
+            }
+        }
+        return std::min(row[b.size()], limit + 1);
+    }
+
+    uint64_t peq[256] = {};
+    for (std::size_t i = 0; i < a.size(); i++) {
+        peq[(unsigned char)a[i]] |= uint64_t(1) << i;
+    }
+
+    uint64_t last = uint64_t(1) << (a.size() - 1);
+    uint64_t pv = ~uint64_t(0);
+    uint64_t mv = 0;
+    int score = (int)a.size();
+    for (std::size_t j = 0; j < b.size(); j++) {
+        uint64_t eq = peq[(unsigned char)b[j]];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last) {
+            score++;
+        } else if (mh & last) {
+            score--;
+        }
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        // Each remaining character can lower the score by at most one
+        if (score - (int)(b.size() - j - 1) > limit) {
+            return limit + 1;
+        }
+    }
+    return std::min(score, limit + 1);
+}
+
+// Case-insensitive prefix and typo-tolerant search over make and model.
+// Every car is indexed under its make, its model and "make model", all
+// lowercased. Prefix lookups walk a range of the sorted term map; fuzzy
+// lookups use shared trigrams to pick candidate terms, then check each
+// with boundedEditDistance. Both stay current through add and remove.
+template <typename T>
+class SearchIndex {
+private:
+    // Removal swaps the last entry into the freed spot, so each posting
+    // keeps the positions it needs to do that without searching.
+    struct Term {
+        std::string text;
+        std::vector<T> items;
+        std::unordered_map<T, std::size_t> itemSlots;
+        // Each trigram of text, and where this term sits in its posting
+        std::vector<std::pair<std::string, std::size_t>> gramSlots;
+    };
+
+    // Lowercased term -> its slot in termTable, kept sorted for prefix search
+    std::map<std::string, std::size_t> termIds;
+    std::vector<Term> termTable;
+    std::vector<std::size_t> freeIds;
+
+    // Trigram -> ids of the terms containing it
+    std::unordered_map<std::string, std::vector<std::size_t>> trigrams;
+
+    static std::string normalize(const std::string& text) {
+        std::string folded = text;
+        for (char& c : folded) {
+            c = (char)std::tolower((unsigned char)c);
+        }
+        return folded;
+    }
+
+    // Distinct trigrams of term, padded so short terms still have some
+    static std::vector<std::string> trigramsOf(const std::string& term) {
+        std::string padded = "  " + term + " ";
+        std::vector<std::string> grams;
+        for (std::size_t i = 0; i + 3 <= padded.size(); i++) {
+            grams.push_back(padded.substr(i, 3));
+        }
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        return grams;
+    }
+
+    static std::vector<std::string> termsOf(const T& item) {
+        std::string make = normalize(item->getMake());
+        std::string model = normalize(item->getModel());
+        if (make == model) {
+            return {make, make + " " + model};
+        }
+        return {make, model, make + " " + model};
+    }
+
+    void addTerm(const std::string& term, const T& item) {
+        auto found = termIds.find(term);
+        if (found != termIds.end()) {
+            Term& existing = termTable[found->second];
+            if (existing.itemSlots.insert(std::make_pair(item, existing.items.size())).second) {
+                existing.items.push_back(item);
+            }
+            return;
+        }
+
+        std::size_t id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        } else {
+            id = termTable.size();
+            termTable.push_back(Term());
+        }
+        Term& created = termTable[id];
+        created.text = term;
+        created.items.push_back(item);
+        created.itemSlots[item] = 0;
+        termIds[term] = id;
+
+        for (const std::string& gram : trigramsOf(term)) {
+            std::vector<std::size_t>& posting = trigrams[gram];
+            created.gramSlots.push_back(std::make_pair(gram, posting.size()));
+            posting.push_back(id);
+        }
+    }
+
+    bool removeTerm(const std::string& term, const T& item) {
+        auto found = termIds.find(term);
+        if (found == termIds.end()) {
+            return false;
+        }
+
+        std::size_t id = found->second;
+        Term& entry = termTable[id];
+        auto slot = entry.itemSlots.find(item);
+        if (slot == entry.itemSlots.end()) {
+            return false;
+        }
+
+        T moved = entry.items.back();
+        entry.items[slot->second] = moved;
+        entry.itemSlots[moved] = slot->second;
+        entry.items.pop_back();
+        entry.itemSlots.erase(item);
+
+        if (entry.items.empty()) {
+            for (const std::pair<std::string, std::size_t>& gramSlot : entry.gramSlots) {
+                std::vector<std::size_t>& posting = trigrams[gramSlot.first];
+                std::size_t movedId = posting.back();
+                posting[gramSlot.second] = movedId;
+                posting.pop_back();
+
+                // Point the moved term at its new spot in this posting
+                for (std::pair<std::string, std::size_t>& other : termTable[movedId].gramSlots) {
+                    if (other.first == gramSlot.first) {
+                        other.second = gramSlot.second;
+                        break;
+                    }
+                }
+
+                if (posting.empty()) {
+                    trigrams.erase(gramSlot.first);
+                }
+            }
+            entry.text.clear();
+            entry.gramSlots.clear();
+            termIds.erase(found);
+            freeIds.push_back(id);
+        }
+        return true;
+    }
+
+    // Append the items of each term id to matches, skipping repeats
+    std::vector<T> collect(const std::vector<std::size_t>& ids, std::size_t limit) const {
+        std::vector<T> matches;
+        for (std::size_t id : ids) {
+            for (const T& item : termTable[id].items) {
+                if (std::find(matches.begin(), matches.end(), item) == matches.end()) {
+                    matches.push_back(item);
+                    if (matches.size() == limit) {
+                        return matches;
+                    }
+                }
+            }
+        }
+        return matches;
+    }
+
+public:
+    void add(T item) {
+        for (const std::string& term : termsOf(item)) {
+            addTerm(term, item);
+        }
+    }
+
+    // Call before the item is deleted; make and model must not have changed
+    bool remove(T item) {
+        bool removed = false;
+        for (const std::string& term : termsOf(item)) {
+            removed = removeTerm(term, item) || removed;
+        }
+        return removed;
+    }
+
+    // Items indexed under exactly text, such as "toyota camry" for a Toyota
+    // Camry; case is ignored
+    std::vector<T> exactMatches(const std::string& text) const {
+        auto found = termIds.find(normalize(text));
+        if (found == termIds.end()) {
+            return std::vector<T>();
+        }
+        return termTable[found->second].items;
+    }
+
+    // Items whose make, model or "make model" starts with prefix. Exact
+    // matches come first, then shorter (closer) terms, then term order.
+    std::vector<T> prefixSearch(const std::string& prefix, std::size_t limit = 20) const {
+        std::string folded = normalize(prefix);
+        std::vector<std::map<std::string, std::size_t>::const_iterator> matches;
+        for (auto it = termIds.lower_bound(folded);
+             it != termIds.end() && it->first.compare(0, folded.size(), folded) == 0; ++it) {
+            matches.push_back(it);
+        }
+
+        // A car sits under up to three terms, so keep taking the next best
+        // term until limit distinct cars are in hand. The heap ranks only
+        // as many terms as that takes.
+        auto worse = [](const std::map<std::string, std::size_t>::const_iterator& a,
+                        const std::map<std::string, std::size_t>::const_iterator& b) {
+            if (a->first.size() != b->first.size()) {
+                return a->first.size() > b->first.size();
+            }
+            return a->first > b->first;
+        };
+        std::make_heap(matches.begin(), matches.end(), worse);
+
+        std::vector<T> found;
+        std::unordered_set<T> seen;
+        while (!matches.empty() && found.size() < limit) {
+            std::pop_heap(matches.begin(), matches.end(), worse);
+            for (const T& item : termTable[matches.back()->second].items) {
+                if (seen.insert(item).second) {
+                    found.push_back(item);
+                    if (found.size() == limit) {
+                        break;
+                    }
+                }
+            }
+            matches.pop_back();
+        }
+        return found;
+    }
+
+    // Items within maxEdits typos of query, closest first. A negative
+    // maxEdits allows one typo for short queries and two otherwise.
+    std::vector<T> fuzzySearch(const std::string& query, std::size_t limit = 20, int maxEdits = -1) const {
+        std::string folded = normalize(query);
+        if (maxEdits < 0) {
+            maxEdits = folded.size() <= 4 ? 1 : 2;
+        }
+
+        // One edit touches at most three trigrams, so a close term has to
+        // share at least this many with the query
+        std::vector<std::string> queryGrams = trigramsOf(folded);
+        int needed = (int)queryGrams.size() - 3 * maxEdits;
+
+        std::vector<std::pair<int, std::size_t>> ranked;
+        auto check = [&](std::size_t id) {
+            int distance = boundedEditDistance(folded, termTable[id].text, maxEdits);
+            if (distance <= maxEdits) {
+                ranked.push_back(std::make_pair(distance, id));
+            }
+        };
+
+        if (needed <= 0) {
+            for (const auto& entry : termIds) {
+                check(entry.second);
+            }
+        } else {
+            std::vector<int> shared(termTable.size(), 0);
+            for (const std::string& gram : queryGrams) {
+                auto posting = trigrams.find(gram);
+                if (posting == trigrams.end()) {
+                    continue;
+                }
+                for (std::size_t id : posting->second) {
+                    if (++shared[id] == needed) {
+                        check(id);
+                    }
+                }
+            }
+        }
+
+        std::sort(ranked.begin(), ranked.end(),
+                  [this](const std::pair<int, std::size_t>& a, const std::pair<int, std::size_t>& b) {
+                      if (a.first != b.first) {
+                          return a.first < b.first;
+                      }
+                      return termTable[a.second].text < termTable[b.second].text;
+                  });
+
+        std::vector<std::size_t> ids;
+        for (const std::pair<int, std::size_t>& match : ranked) {
+            ids.push_back(match.second);
+        }
+        return collect(ids, limit);
+    }
+};
+
+// Add a feed batch to the catalog, replacing listings it already has.
+// Within the batch the last copy of each listing (per IdentityOf) wins and
+// the earlier copies are released through the list's policy. Existing
+// listings with a matching identity are unlinked from the list and retired
+// by the tree, which releases them once no snapshot can reach them; a car
+// the batch sends again by pointer is moved instead, never released.
+// Returns how many listings already in the catalog the batch updated.
+template <typename IdentityOf = ByListing, typename T, typename ListKey, typename ListCompare,
+          typename ListRelease, typename TreeKey, typename TreeCompare, typename TreeRelease>
+int upsertBatch(LinkedList<T, ListKey, ListCompare, ListRelease>& list,
+                BinarySearchTree<T, TreeKey, TreeCompare, TreeRelease>& tree,
+                const std::vector<T>& batch, SearchIndex<T>* search = nullptr) {
+    static_assert(std::is_same<ListRelease, TreeRelease>::value,
+                  "the list and tree of one catalog must share an ownership policy");
+    IdentityOf identityOf;
+
+    typedef decltype(identityOf(std::declval<const T&>())) Identity;
+    std::unordered_map<Identity, std::size_t> latest;
+    std::vector<T> unique;
+    std::vector<T> superseded;
+    for (T item : batch) {
+        auto inserted = latest.insert(std::make_pair(identityOf(item), unique.size()));
+        if (inserted.second) {
+            unique.push_back(item);
+        } else if (unique[inserted.first->second] != item) {
+            superseded.push_back(unique[inserted.first->second]);
+            unique[inserted.first->second] = item;
+        }
+    }
+
+    // One walk both unlinks the matching listings and links in the batch
+    std::vector<T> unlinked = list.mergeBatch(unique, [&latest, &identityOf](const T& item) {
+        return latest.count(identityOf(item)) != 0;
+    });
+
+    // Cars the batch sends again stay live; only the rest are replaced
+    std::unordered_set<T> live(unique.begin(), unique.end());
+    std::vector<T> replaced;
+    std::vector<T> resent;
+    for (T item : unlinked) {
+        if (live.count(item) != 0) {
+            resent.push_back(item);
+        } else {
+            replaced.push_back(item);
+        }
+    }
+
+    // The search index must let go before the tree can delete anything
+    if (search != nullptr) {
+        for (T item : replaced) {
+            search->remove(item);
+        }
+        for (T item : unique) {
+            search->add(item);
+        }
+    }
+
+    tree.mergeBatch(unique, replaced, resent);
+
+    // Earlier copies that were listed are retired with replaced; release the
+    // rest, once each, unless a later copy kept the same car
+    std::unordered_set<T> handled(unlinked.begin(), unlinked.end());
+    handled.insert(unique.begin(), unique.end());
+    for (T item : superseded) {
+        if (handled.insert(item).second) {
+            ListRelease()(item);
+        }
+    }
+    return (int)unlinked.size();
+}
+
+#endif
@@ -0,0 +1,519 @@
+// Car Catalog Project
+// Checks for the containers in catalog.h. Run with: make test
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "catalog.h"
+
+using namespace std;
+
+int failures = 0;
+
+#define CHECK(condition)                                                   \
+    do {                                                                   \
+        if (!(condition)) {                                                \
+            cout << "FAILED: " << #condition << " (line " << __LINE__ << ")" << endl; \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+// Just enough of a car for the containers
+class TestCar {
+public:
+    string make;
+    string model;
+    int year;
+    double cost;
+    string type;
+
+    TestCar(string make, string model, int year, double cost, string type = "Sedan")
+        : make(make), model(model), year(year), cost(cost), type(type) {}
+
+    string getMake() const { return make; }
+    string getModel() const { return model; }
+    int getModelYear() const { return year; }
+    double getCost() const { return cost; }
+    string getType() const { return type; }
+};
+
+bool costSorted(const vector<TestCar*>& cars) {
+    for (size_t i = 1; i < cars.size(); i++) {
+        if (cars[i]->cost < cars[i - 1]->cost) {
+            return false;
+        }
+    }
+    return true;
+}
+
+vector<TestCar*> randomCars(size_t count, unsigned int seed) {
+    mt19937 random(seed);
+    vector<TestCar*> cars;
+    for (size_t i = 0; i < count; i++) {
+        cars.push_back(new TestCar("Make", "Model" + to_string(i), 2000, (double)(random() % 5000)));
+    }
+    return cars;
+}
+
+// Dropping a snapshot pinned across many updates must not recurse per version
+void testSnapshotRelease() {
+    BinarySearchTree<TestCar*> tree;
+    tree.insert(new TestCar("Toyota", "Camry", 2022, 25000));
+    BinarySearchTree<TestCar*>::Snapshot view = tree.snapshot();
+
+    for (int i = 0; i < 50000; i++) {
+        TestCar* car = new TestCar("Kia", "Rio", 2020, i % 7);
+        tree.insert(car);
+        tree.remove(car);
+    }
+
+    CHECK(tree.exportLowToHigh(view).size() == 1);
+    view.reset();
+    CHECK(tree.exportLowToHigh(tree.snapshot()).size() == 1);
+
+    vector<TestCar*> left = tree.exportLowToHigh(tree.snapshot());
+    tree.remove(left[0]);
+}
+
+// Height of a subtree, or -1 if it breaks the AVL balance rule
+int checkedHeight(const TreeNode<TestCar*>* node) {
+    if (node == nullptr) {
+        return 0;
+    }
+    int left = checkedHeight(node->left.get());
+    int right = checkedHeight(node->right.get());
+    if (left < 0 || right < 0 || left - right > 1 || right - left > 1 ||
+        node->height != 1 + max(left, right)) {
+        return -1;
+    }
+    return node->height;
+}
+
+// Cars arriving in cost order must not degrade the tree into a list
+void testTreeStaysBalanced() {
+    BinarySearchTree<TestCar*> tree;
+    BinarySearchTree<TestCar*>::Snapshot pinned = tree.snapshot();
+    vector<TestCar*> cars;
+    for (int i = 0; i < 20000; i++) {
+        cars.push_back(new TestCar("Make", "Model", 2000, i));
+        tree.insert(cars.back());
+    }
+
+    BinarySearchTree<TestCar*>::Snapshot view = tree.snapshot();
+    int height = checkedHeight(view->root.get());
+    CHECK(height > 0);
+    // An AVL tree of 20000 nodes is at most 1.44 * log2(20000) ~ 21 high
+    CHECK(height <= 21);
+
+    mt19937 random(5);
+    shuffle(cars.begin(), cars.end(), random);
+    for (int i = 0; i < 15000; i++) {
+        CHECK(tree.remove(cars[i]));
+    }
+    view = tree.snapshot();
+    CHECK(checkedHeight(view->root.get()) > 0);
+    vector<TestCar*> left = tree.exportLowToHigh(view);
+    CHECK(left.size() == 5000);
+    CHECK(costSorted(left));
+    CHECK(tree.exportLowToHigh(pinned).empty());
+
+    for (TestCar* car : left) {
+        tree.remove(car);
+    }
+}
+
+// A reader keeps taking and dropping snapshots while a writer updates
+void testConcurrentReaders() {
+    BinarySearchTree<TestCar*> tree;
+    for (int i = 0; i < 100; i++) {
+        tree.insert(new TestCar("Make", "Model" + to_string(i), 2000, i));
+    }
+
+    bool readerOk = true;
+    thread reader([&tree, &readerOk]() {
+        for (int i = 0; i < 2000; i++) {
+            BinarySearchTree<TestCar*>::Snapshot view = tree.snapshot();
+            size_t count = 0;
+            double lastCost = -1;
+            tree.displayLowToHigh(view, [&count, &lastCost, &readerOk](TestCar* car) {
+                if (car->cost < lastCost) {
+                    readerOk = false;
+                }
+                lastCost = car->cost;
+                count++;
+            });
+            if (count != 100 && count != 101) {
+                readerOk = false;
+            }
+        }
+    });
+
+    for (int i = 0; i < 2000; i++) {
+        TestCar* car = new TestCar("Kia", "Rio", 2020, i % 150);
+        tree.insert(car);
+        tree.remove(car);
+    }
+    reader.join();
+    CHECK(readerOk);
+
+    for (TestCar* car : tree.exportLowToHigh(tree.snapshot())) {
+        tree.remove(car);
+    }
+}
+
+// Bulk build and export with the work split eight ways, whatever the core count
+void testBulkBuildAndExport() {
+    const unsigned int threads = 8;
+
+    for (size_t count : {0, 1, 2, 1000, 100000}) {
+        vector<TestCar*> cars = randomCars(count, (unsigned int)count);
+        BinarySearchTree<TestCar*> tree;
+        tree.bulkBuild(cars, threads);
+
+        BinarySearchTree<TestCar*>::Snapshot view = tree.snapshot();
+        vector<TestCar*> exported = tree.exportLowToHigh(view, threads);
+        CHECK(exported.size() == count);
+        CHECK(costSorted(exported));
+        vector<TestCar*> expected = cars;
+        vector<TestCar*> actual = exported;
+        sort(expected.begin(), expected.end());
+        sort(actual.begin(), actual.end());
+        CHECK(actual == expected);
+
+        vector<TestCar*> walked;
+        tree.displayLowToHigh(view, [&walked](TestCar* car) { walked.push_back(car); });
+        CHECK(walked == exported);
+
+        // The built tree still takes normal updates
+        if (count > 0) {
+            TestCar* extra = new TestCar("Ford", "F-150", 2021, 2500);
+            tree.insert(extra);
+            CHECK(tree.remove(exported[count / 2]));
+            vector<TestCar*> updated = tree.exportLowToHigh(tree.snapshot(), threads);
+            CHECK(updated.size() == count);
+            CHECK(costSorted(updated));
+            cars.push_back(extra);
+            cars.erase(find(cars.begin(), cars.end(), exported[count / 2]));
+        }
+
+        for (TestCar* car : cars) {
+            delete car;
+        }
+    }
+
+    // Thread counts that are not a power of two split the same way
+    vector<TestCar*> cars = randomCars(50000, 3);
+    BinarySearchTree<TestCar*, ByCost, less<>, KeepItem> tree;
+    tree.bulkBuild(cars, 3);
+    vector<TestCar*> serial = tree.exportLowToHigh(tree.snapshot(), 1);
+    CHECK(serial.size() == cars.size());
+    CHECK(costSorted(serial));
+    for (unsigned int split : {0u, 2u, 3u, 5u, 7u}) {
+        CHECK(tree.exportLowToHigh(tree.snapshot(), split) == serial);
+    }
+    for (TestCar* car : cars) {
+        delete car;
+    }
+}
+
+// Plain dynamic-programming edit distance to check the bit-parallel one
+int referenceEditDistance(const string& a, const string& b) {
+    vector<vector<int>> table(a.size() + 1, vector<int>(b.size() + 1));
+    for (size_t i = 0; i <= a.size(); i++) {
+        table[i][0] = (int)i;
+    }
+    for (size_t j = 0; j <= b.size(); j++) {
+        table[0][j] = (int)j;
+    }
+    for (size_t i = 1; i <= a.size(); i++) {
+        for (size_t j = 1; j <= b.size(); j++) {
+            table[i][j] = min({table[i - 1][j] + 1, table[i][j - 1] + 1,
+                               table[i - 1][j - 1] + (a[i - 1] != b[j - 1])});
+        }
+    }
+    return table[a.size()][b.size()];
+}
+
+void testEditDistance() {
+    mt19937 random(3);
+    auto randomText = [&random](size_t length) {
+        string text;
+        for (size_t i = 0; i < length; i++) {
+            text += (char)('a' + random() % 3);
+        }
+        return text;
+    };
+
+    for (int i = 0; i < 20000; i++) {
+        // Every tenth pair is long enough to take the row-by-row path
+        size_t longest = i % 10 == 0 ? 90 : 12;
+        string a = randomText(random() % longest);
+        string b = randomText(random() % longest);
+        int limit = (int)(random() % 5);
+        CHECK(boundedEditDistance(a, b, limit) == min(referenceEditDistance(a, b), limit + 1));
+    }
+}
+
+void testSearchIndex() {
+    SearchIndex<TestCar*> search;
+    TestCar camry("Toyota", "Camry", 2022, 25000);
+    TestCar corolla("Toyota", "Corolla", 2021, 21000);
+    TestCar f150("Ford", "F-150", 2021, 40000, "Truck");
+    TestCar f("Ford", "F", 1990, 500);
+    TestCar fiesta("Ford", "Fiesta", 2015, 9000);
+    TestCar crv("Honda", "CR-V", 2023, 32000, "SUV");
+    for (TestCar* car : {&camry, &corolla, &f150, &f, &fiesta, &crv}) {
+        search.add(car);
+    }
+
+    // Case-insensitive, exact and shorter terms first
+    vector<TestCar*> prefixed = search.prefixSearch("f");
+    CHECK(prefixed.size() == 3);
+    CHECK(!prefixed.empty() && prefixed[0] == &f);
+    CHECK(search.prefixSearch("F-") == vector<TestCar*>({&f150}));
+    CHECK(search.prefixSearch("TOYOTA c").size() == 2);
+    CHECK(search.prefixSearch("ford", 2).size() == 2);
+
+    // Typos, closest first
+    CHECK(search.fuzzySearch("toyota camri") == vector<TestCar*>({&camry}));
+    CHECK(search.fuzzySearch("corola") == vector<TestCar*>({&corolla}));
+    vector<TestCar*> toyotas = search.fuzzySearch("Toyta");
+    CHECK(toyotas.size() == 2);
+    CHECK(search.fuzzySearch("zzzzzz").empty());
+
+    // Whole-term lookups ignore case but not partial words
+    CHECK(search.exactMatches("TOYOTA camry") == vector<TestCar*>({&camry}));
+    CHECK(search.exactMatches("ford").size() == 3);
+    CHECK(search.exactMatches("toyota cam").empty());
+
+    // Removal keeps every lookup current
+    CHECK(search.remove(&f150));
+    CHECK(!search.remove(&f150));
+    CHECK(search.prefixSearch("f-").empty());
+    CHECK(search.prefixSearch("ford").size() == 2);
+    for (TestCar* car : {&camry, &corolla, &f, &fiesta, &crv}) {
+        CHECK(search.remove(car));
+    }
+    CHECK(search.prefixSearch("").empty());
+    CHECK(search.fuzzySearch("toyota").empty());
+
+    // Each car matches under three terms, yet limit distinct cars come back
+    vector<TestCar*> sCars;
+    for (int i = 0; i < 10; i++) {
+        sCars.push_back(new TestCar(string("s") + char('a' + 2 * i), string("s") + char('b' + 2 * i), 2000, i));
+        search.add(sCars.back());
+    }
+    vector<TestCar*> six = search.prefixSearch("s", 6);
+    CHECK(six.size() == 6);
+    sort(six.begin(), six.end());
+    CHECK(unique(six.begin(), six.end()) == six.end());
+    CHECK(search.prefixSearch("s", 50).size() == 10);
+    for (TestCar* car : sCars) {
+        search.remove(car);
+        delete car;
+    }
+
+    // Terms with hundreds of trigrams still count every shared one
+    mt19937 random(11);
+    string longText;
+    for (int i = 0; i < 600; i++) {
+        longText += char('a' + random() % 26);
+    }
+    TestCar longModel("Make", longText, 2000, 1);
+    search.add(&longModel);
+    CHECK(search.fuzzySearch(longModel.model) == vector<TestCar*>({&longModel}));
+    CHECK(search.remove(&longModel));
+}
+
+void testUpsertBatch() {
+    LinkedList<TestCar*> list;
+    BinarySearchTree<TestCar*> tree;
+    SearchIndex<TestCar*> search;
+
+    // Duplicates inside one batch: the last copy wins
+    vector<TestCar*> first = {new TestCar("Toyota", "Camry", 2022, 25000),
+                              new TestCar("Honda", "CR-V", 2023, 32000, "SUV"),
+                              new TestCar("Honda", "CR-V", 2023, 31000, "SUV"),
+                              new TestCar("Ford", "F-150", 2021, 40000, "Truck")};
+    CHECK(upsertBatch(list, tree, first, &search) == 0);
+    CHECK(list.displayAll([](TestCar*) {}) == 3);
+    CHECK(search.prefixSearch("honda") == vector<TestCar*>({first[2]}));
+
+    // A resent listing replaces the old one; old snapshots still see it
+    BinarySearchTree<TestCar*>::Snapshot before = tree.snapshot();
+    vector<TestCar*> second = {new TestCar("Toyota", "Camry", 2022, 23000),
+                               new TestCar("Kia", "Rio", 2020, 15000)};
+    CHECK(upsertBatch(list, tree, second, &search) == 1);
+
+    vector<TestCar*> current = tree.exportLowToHigh(tree.snapshot());
+    CHECK(current.size() == 4);
+    CHECK(costSorted(current));
+    CHECK(find(current.begin(), current.end(), first[0]) == current.end());
+    CHECK(find(current.begin(), current.end(), second[0]) != current.end());
+    vector<TestCar*> old = tree.exportLowToHigh(before);
+    CHECK(find(old.begin(), old.end(), first[0]) != old.end());
+    CHECK(search.prefixSearch("toyota camry") == vector<TestCar*>({second[0]}));
+    before.reset();
+
+    // Categories stay grouped in the list
+    vector<string> types;
+    list.displayAll([&types](TestCar* car) { types.push_back(car->type); });
+    CHECK(is_sorted(types.begin(), types.end()));
+
+    // Any hashable identity works, e.g. the model year alone
+    LinkedList<TestCar*, ByCategory, less<>, KeepItem> byYearList;
+    BinarySearchTree<TestCar*, ByCost, less<>, KeepItem> byYearTree;
+    TestCar a("Kia", "Rio", 2020, 1), b("Kia", "Soul", 2020, 2);
+    CHECK(upsertBatch<ByYear>(byYearList, byYearTree, vector<TestCar*>({&a})) == 0);
+    CHECK(upsertBatch<ByYear>(byYearList, byYearTree, vector<TestCar*>({&b})) == 1);
+    CHECK(byYearTree.exportLowToHigh(byYearTree.snapshot()) == vector<TestCar*>({&b}));
+}
+
+// One merge pass leaves the list as adding and removing one by one would
+void testListMergeMatchesAdds() {
+    const vector<string> types = {"SUV", "Sedan", "Truck", "Van"};
+    mt19937 random(17);
+    vector<TestCar> cars;
+    for (int i = 0; i < 300; i++) {
+        cars.push_back(TestCar("Make", "Model" + to_string(i), 2000, i, types[random() % types.size()]));
+    }
+
+    LinkedList<TestCar*, ByCategory, less<>, KeepItem> merged;
+    LinkedList<TestCar*, ByCategory, less<>, KeepItem> added;
+    for (int i = 0; i < 200; i++) {
+        merged.addByCategory(&cars[i]);
+        added.addByCategory(&cars[i]);
+    }
+
+    vector<TestCar*> batch;
+    for (int i = 200; i < 300; i++) {
+        batch.push_back(&cars[i]);
+        added.addByCategory(&cars[i]);
+    }
+    auto odd = [](TestCar* car) { return (int)car->cost % 2 == 1 && car->cost < 200; };
+    vector<TestCar*> removed = merged.mergeBatch(batch, odd);
+    CHECK(removed.size() == 100);
+    for (TestCar* car : removed) {
+        CHECK(odd(car));
+        CHECK(added.remove(car));
+    }
+
+    vector<TestCar*> mergedOrder;
+    vector<TestCar*> addedOrder;
+    merged.displayAll([&mergedOrder](TestCar* car) { mergedOrder.push_back(car); });
+    added.displayAll([&addedOrder](TestCar* car) { addedOrder.push_back(car); });
+    CHECK(mergedOrder.size() == 200);
+    CHECK(mergedOrder == addedOrder);
+}
+
+// Deletes like DeleteItem and counts how many cars it has deleted
+int releasedCars = 0;
+struct CountedDelete {
+    void operator()(TestCar* car) const {
+        releasedCars++;
+        delete car;
+    }
+};
+
+// Replaced, removed and still-listed cars are each released exactly once
+void testEveryCarReleasedOnce() {
+    releasedCars = 0;
+    {
+        LinkedList<TestCar*, ByCategory, less<>, CountedDelete> list;
+        BinarySearchTree<TestCar*, ByCost, less<>, CountedDelete> tree;
+        upsertBatch(list, tree, vector<TestCar*>({new TestCar("Kia", "Rio", 2020, 1),
+                                                  new TestCar("Kia", "Rio", 2020, 2),
+                                                  new TestCar("Kia", "Soul", 2021, 3)}));
+        CHECK(releasedCars == 1);
+
+        BinarySearchTree<TestCar*, ByCost, less<>, CountedDelete>::Snapshot before = tree.snapshot();
+        upsertBatch(list, tree, vector<TestCar*>({new TestCar("Kia", "Rio", 2020, 4)}));
+        CHECK(releasedCars == 1);
+        before.reset();
+        CHECK(releasedCars == 2);
+
+        TestCar* soul = list.find("Kia", "Soul");
+        list.remove(soul);
+        tree.remove(soul);
+        CHECK(releasedCars == 3);
+    }
+    CHECK(releasedCars == 4);
+}
+
+// A car sent again by pointer, alone or twice in a batch, stays live
+void testResentCarsStayLive() {
+    releasedCars = 0;
+    {
+        LinkedList<TestCar*, ByCategory, less<>, CountedDelete> list;
+        BinarySearchTree<TestCar*, ByCost, less<>, CountedDelete> tree;
+        vector<TestCar*> cars;
+        for (int i = 0; i < 20; i++) {
+            cars.push_back(new TestCar("Make", "Model" + to_string(i), 2000, i));
+        }
+        upsertBatch(list, tree, cars);
+
+        // Already listed: moved, not replaced (path-copying, then rebuild
+        // because its cost was edited in place)
+        CHECK(upsertBatch(list, tree, vector<TestCar*>({cars[3]})) == 1);
+        cars[4]->cost = 100;
+        CHECK(upsertBatch(list, tree, vector<TestCar*>({cars[4]})) == 1);
+        CHECK(releasedCars == 0);
+
+        // Twice in one batch, and superseded in between
+        TestCar* twice = new TestCar("Kia", "Rio", 2020, 50);
+        TestCar* between = new TestCar("Kia", "Rio", 2020, 60);
+        CHECK(upsertBatch(list, tree, vector<TestCar*>({twice, twice, between, twice, between, twice})) == 0);
+        CHECK(releasedCars == 1);
+        CHECK(twice->cost == 50);
+
+        vector<TestCar*> exported = tree.exportLowToHigh(tree.snapshot());
+        CHECK(exported.size() == 21);
+        CHECK(costSorted(exported));
+        CHECK(exported.back() == cars[4]);
+        CHECK(list.displayAll([](TestCar*) {}) == 21);
+    }
+    CHECK(releasedCars == 22);
+}
+
+// A small upsert into a large tree shares most nodes with the old version
+void testSmallUpsertSharesNodes() {
+    LinkedList<TestCar*> list;
+    BinarySearchTree<TestCar*> tree;
+    vector<TestCar*> cars;
+    for (int i = 0; i < 1000; i++) {
+        cars.push_back(new TestCar("Make", "Model" + to_string(i), 2000, i));
+    }
+    upsertBatch(list, tree, cars);
+
+    BinarySearchTree<TestCar*>::Snapshot before = tree.snapshot();
+    upsertBatch(list, tree, vector<TestCar*>({new TestCar("Make", "Model5", 2000, 5)}));
+    BinarySearchTree<TestCar*>::Snapshot after = tree.snapshot();
+
+    CHECK(before->root != after->root);
+    CHECK(before->root->left == after->root->left || before->root->right == after->root->right);
+    CHECK(tree.exportLowToHigh(after).size() == 1000);
+}
+
+int main() {
+    testSnapshotRelease();
+    testConcurrentReaders();
+    testTreeStaysBalanced();
+    testBulkBuildAndExport();
+    testEditDistance();
+    testSearchIndex();
+    testListMergeMatchesAdds();
+    testUpsertBatch();
+    testEveryCarReleasedOnce();
+    testResentCarsStayLive();
+    testSmallUpsertSharesNodes();
+
+    if (failures > 0) {
+        cout << failures << " check(s) failed." << endl;
+        return 1;
+    }
+    cout << "All catalog checks passed." << endl;
+    return 0;
+}
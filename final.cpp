@@ -4,6 +4,8 @@
 #include <string>
 #include <stdexcept>
 #include <limits>
+#include <vector>
+#include "catalog.h"
 
 using namespace std;
 
@@ -112,195 +114,83 @@ public:
     }
 };
 
-// Node class for the linked list
-class Node {
-public:
-    Car* car;
-    Node* next;
-
-    Node(Car* car) {
-        this->car = car;
-        next = nullptr;
-    }
-};
-
-// Linked List class
-class LinkedList {
-private:
-    Node* head;
-
-public:
-    LinkedList() {
-        head = nullptr;
-    }
-
-    // Destructor to free memory
-    ~LinkedList() {
-        Node* current = head;
-        while (current != nullptr) {
-            Node* next = current->next;
-            delete current->car; // Delete the Car object
-            delete current; // Delete the Node
-            current = next;
-        }
-    }
-
-    // Add a car to the linked list
-    void addCar(Car* car) {
-        Node* newNode = new Node(car);
-
-        // If list is empty or the new car should be at the beginning
-        if (head == nullptr || car->getType() < head->car->getType()) {
-            newNode->next = head;
-            head = newNode;
-            return;
-        }
-
-        // Find the right position to insert
-        Node* current = head;
-        while (current->next != nullptr && current->next->car->getType() <= car->getType()) {
-            current = current->next;
-        }
-
-        newNode->next = current->next;
-        current->next = newNode;
-    }
-
-    // show all cars in the linked list
-    void showAllCars() const {
-        if (head == nullptr) {
-            cout << "No cars in the catalog." << endl;
-            return;
-        }
-
-        Node* current = head;
-        int count = 1;
-        while (current != nullptr) {
-            cout << "\n--- Car #" << count++ << " ---" << endl;
-            current->car->showInfo();
-            current = current->next;
-        }
-    }
-
-    // show cars of a specific type
-    void showCarsByType(const string& type) const {
-        if (head == nullptr) {
-            cout << "No cars in the catalog." << endl;
-            return;
-        }
-
-        Node* current = head;
-        int count = 0;
-        while (current != nullptr) {
-            if (current->car->getType() == type) {
-                cout << "\n--- " << type << " #" << ++count << " ---" << endl;
-                current->car->showInfo();
-            }
-            current = current->next;
-        }
-
-        if (count == 0) {
-            cout << "No " << type << "s found in the catalog." << endl;
-        }
-    }
-};
-
-// Node class for Binary Search Tree
-class TreeNode {
-public:
-    Car* car;
-    TreeNode* left;
-    TreeNode* right;
-
-    TreeNode(Car* car) {
-        this->car = car;
-        left = nullptr;
-        right = nullptr;
-    }
-};
-
-// Class used to sort cars by costs
-class BinarySearchTree {
-private:
-    TreeNode* root;
-
-    TreeNode* insert(TreeNode* node, Car* car) {
-        if (node == nullptr) {
-            return new TreeNode(car);
-        }
-
-        if (*car < *(node->car)) {
-            node->left = insert(node->left, car);
-        } else {
-            node->right = insert(node->right, car);
-        }
+// Print one car followed by a blank line
+void showCar(Car* car) {
+    car->showInfo();
+    cout << endl;
+}
 
-        return node;
+// show all cars in the linked list
+void showAllCars(const LinkedList<Car*>& carList) {
+    if (carList.isEmpty()) {
+        cout << "No cars in the catalog." << endl;
+        return;
     }
 
-    // low to high cost Traversal
-    void inOrderTraversal(TreeNode* node) const {
-        if (node != nullptr) {
-            inOrderTraversal(node->left);
-            node->car->showInfo();
-            cout << endl;
-            inOrderTraversal(node->right);
-        }
-    }
+    int count = 0;
+    carList.displayAll([&count](Car* car) {
+        cout << "\n--- Car #" << ++count << " ---" << endl;
+        car->showInfo();
+    });
+}
 
-    // high to low cost Traversal
-    void reverseInOrderTraversal(TreeNode* node) const {
-        if (node != nullptr) {
-            reverseInOrderTraversal(node->right);
-            node->car->showInfo();
-            cout << endl;
-            reverseInOrderTraversal(node->left);
-        }
+// show cars of a specific type
+void showCarsByType(const LinkedList<Car*>& carList, const string& type) {
+    if (carList.isEmpty()) {
+        cout << "No cars in the catalog." << endl;
+        return;
     }
 
+    int count = 0;
+    carList.displayByCategory(type, [&count, &type](Car* car) {
+        cout << "\n--- " << type << " #" << ++count << " ---" << endl;
+        car->showInfo();
+    });
 
-    void nodeDeletion(TreeNode* node) {
-        if (node != nullptr) {
-            nodeDeletion(node->left);
-            nodeDeletion(node->right);
-            delete node;
-        }
-    }
-
-public:
-    BinarySearchTree() {
-        root = nullptr;
+    if (count == 0) {
+        cout << "No " << type << "s found in the catalog." << endl;
     }
+}
 
-    ~BinarySearchTree() {
-        nodeDeletion(root);
+// show cars sorted by low to high costs
+void carCostLowToHigh(const BinarySearchTree<Car*>& costTree) {
+    BinarySearchTree<Car*>::Snapshot view = costTree.snapshot();
+    if (view->root == nullptr) {
+        cout << "No cars in the catalog." << endl;
+        return;
     }
 
-    // Use cost to add cars to BST
-    void addCar(Car* car) {
-        root = insert(root, car);
-    }
+    cout << "\n----- Cars Sorted by cost (Low to High) -----" << endl;
+    costTree.displayLowToHigh(view, showCar);
+}
 
-    // show cars sorted by low to high costs
-    void carCostLowToHigh() const {
-        if (root == nullptr) {
-            cout << "No cars in the catalog." << endl;
+// show cars whose make or model starts with query, or else the closest spellings
+void searchCars(const SearchIndex<Car*>& carSearch, const string& query) {
+    vector<Car*> results = carSearch.prefixSearch(query);
+    if (results.empty()) {
+        results = carSearch.fuzzySearch(query);
+        if (results.empty()) {
+            cout << "No cars match \"" << query << "\"." << endl;
             return;
         }
-
-        cout << "\n----- Cars Sorted by cost (Low to High) -----" << endl;
-       inOrderTraversal(root);
+        cout << "No exact match. Did you mean:" << endl;
     }
 
-};
+    int count = 0;
+    for (Car* car : results) {
+        cout << "\n--- Result #" << ++count << " ---" << endl;
+        car->showInfo();
+    }
+}
 
 
 int main() {
-    LinkedList carList;
-    BinarySearchTree costTree;
+    LinkedList<Car*> carList;
+    BinarySearchTree<Car*> costTree;
+    SearchIndex<Car*> carSearch;
 
     int choice;
-    string brand, modelType, type;
+    string brand, modelType, type, query;
     int modelYear, doors;
     double cost, bedLength, towingCapacity;
     bool hasThirdRow;
@@ -317,7 +207,9 @@ int main() {
             cout << "4. show all cars" << endl;
             cout << "5. show cars by type" << endl;
             cout << "6. show cars by cost (Low to High)" << endl;
-            cout << "7. Exit" << endl;
+            cout << "7. Search cars by make or model" << endl;
+            cout << "8. Remove a car" << endl;
+            cout << "9. Exit" << endl;
             cout << "Enter your choice: ";
             
             if (!(cin >> choice)) {
@@ -339,8 +231,9 @@ int main() {
                     cin >> doors;
                     
                     newCar = new Sedan(brand, modelType, modelYear, cost, doors);
-                    carList.addCar(newCar);
-                    costTree.addCar(newCar);
+                    carList.addByCategory(newCar);
+                    costTree.insert(newCar);
+                    carSearch.add(newCar);
                     cout << "Sedan added successfully!" << endl;
                     break;
                 //adding a SUV to Linked List
@@ -357,8 +250,9 @@ int main() {
                     cin >> hasThirdRow;
                     
                     newCar = new SUV(brand, modelType, modelYear, cost, hasThirdRow);
-                    carList.addCar(newCar);
-                    costTree.addCar(newCar);
+                    carList.addByCategory(newCar);
+                    costTree.insert(newCar);
+                    carSearch.add(newCar);
                     cout << "SUV added successfully!" << endl;
                     break;
                 // Add a Truck car Type to Linked List
@@ -377,34 +271,69 @@ int main() {
                     cin >> towingCapacity;
                     
                     newCar = new Truck(brand, modelType, modelYear, cost, bedLength, towingCapacity);
-                    carList.addCar(newCar);
-                    costTree.addCar(newCar);
+                    carList.addByCategory(newCar);
+                    costTree.insert(newCar);
+                    carSearch.add(newCar);
                     cout << "Truck added successfully!" << endl;
                     break;
                 
                 // list all cars
                 case 4: 
-                    carList.showAllCars();
+                    showAllCars(carList);
                     break;
                 // showcase all cars by type
                 case 5: 
                     cout << "Enter car type (Sedan, SUV, or Truck): ";
                     cin >> type;
-                    carList.showCarsByType(type);
+                    showCarsByType(carList, type);
                     break;
                 // show off cars by cost Low to High cost
                 case 6: 
-                    costTree.carCostLowToHigh();
+                    carCostLowToHigh(costTree);
                     break;
-                // Exit the program
+                // Search by make or model, allowing for typos
                 case 7: 
+                    cout << "Enter make or model: ";
+                    getline(cin >> ws, query);
+                    searchCars(carSearch, query);
+                    break;
+                // Remove a car from the LL, the cost tree and the search index
+                case 8: 
+                    cout << "Enter brand: ";
+                    cin >> brand;
+                    cout << "Enter modelType: ";
+                    cin >> modelType;
+
+                    // Match the make and model whatever their case
+                    {
+                        vector<Car*> matches = carSearch.exactMatches(brand + " " + modelType);
+                        if (matches.empty()) {
+                            cout << "Car not found." << endl;
+                            vector<Car*> close = carSearch.fuzzySearch(brand + " " + modelType, 3);
+                            for (Car* car : close) {
+                                cout << "Did you mean " << car->getMake() << " " << car->getModel() << "?" << endl;
+                            }
+                            break;
+                        }
+                        newCar = matches[0];
+                    }
+
+                    // The search index lets go first; the cost tree deletes
+                    // the car once no snapshot can see it
+                    carSearch.remove(newCar);
+                    carList.remove(newCar);
+                    costTree.remove(newCar);
+                    cout << "Car removed successfully!" << endl;
+                    break;
+                // Exit the program
+                case 9: 
                     cout << "Exiting program. Goodbye!" << endl;
                     break;
                 
                 default:
                     cout << "Invalid choice. Please try again." << endl;
             }
-        } while (choice != 7);
+        } while (choice != 9);
     } catch (const exception& e) {
         cout << "Error: " << e.what() << endl;
         cin.clear();